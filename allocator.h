@@ -4,6 +4,10 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 void init_allocator();
 void* my_malloc(size_t size);
 void my_free(void* ptr);
@@ -11,4 +15,132 @@ void my_free(void* ptr);
 void print_memory_state(void);
 void cleanup_allocator();
 
-#endif
\ No newline at end of file
+/*
+ * Aligned and sized variants (dynamic allocator only)
+ *
+ * Mirror C11 aligned_alloc() and C23 free_sized()/free_aligned_sized().
+ * The sized frees check the size and alignment against the block.
+ */
+void* my_aligned_alloc(size_t alignment, size_t size);
+void my_free_sized(void* ptr, size_t size);
+void my_free_aligned_sized(void* ptr, size_t alignment, size_t size);
+
+/*
+ * Lifetime/locality hints (dynamic allocator only)
+ *
+ * Hinted allocations are segregated by region so short-lived temporaries
+ * do not fragment the space between long-lived objects, and hot objects
+ * share cache lines and pages. Unhinted allocations are first-fit above
+ * the hot region, which they only use once the rest of the pool is full.
+ */
+#define ALLOC_SHORT_LIVED  0x1      // Freed soon; placed from the top of the pool down
+#define ALLOC_LONG_LIVED   0x2      // Kept around; placed from the bottom up
+#define ALLOC_HOT          0x4      // Accessed often; packed into a small hot region
+
+void* my_malloc_hint(size_t size, int flags);
+
+typedef struct allocator_stats {
+    size_t total_free;          // Free payload bytes
+    size_t total_used;          // Allocated payload bytes
+    size_t largest_free;        // Biggest single free block
+    size_t free_blocks;
+    size_t used_blocks;
+} allocator_stats_t;
+
+// Fragmentation can be read off as 1 - largest_free / total_free
+void my_allocator_stats(allocator_stats_t* stats);
+
+/*
+ * Warm-up (dynamic allocator only)
+ *
+ * Size class i covers requests up to my_size_class_bytes(i) = 32 << i,
+ * except the last class (ALLOC_SIZE_CLASSES - 1), which is open-ended:
+ * it covers every request over 2048 bytes. my_size_class_bytes() of the
+ * last class (4096) is only the block size warm-up carves for it.
+ * my_allocator_warmup() prefaults (and with ALLOC_WARMUP_MLOCK, locks)
+ * the pool, then pre-carves per_size_class_counts[i] free blocks of
+ * my_size_class_bytes(i) each. Returns 0, or -1 if any part of it failed.
+ */
+#define ALLOC_SIZE_CLASSES 8
+#define ALLOC_WARMUP_MLOCK 0x1
+
+size_t my_size_class_bytes(int size_class);
+int my_allocator_warmup(size_t bytes, const size_t* per_size_class_counts, int flags);
+
+/*
+ * Latency histograms (dynamic allocator only)
+ *
+ * Once enabled, every allocation and free is timed (clock_gettime, or
+ * rdtsc cycles when built with -DALLOCATOR_LATENCY_RDTSC on x86) and
+ * counted in a log-linear histogram per operation, path and size class.
+ * Both allocation and free are classed by the requested size.
+ * Percentiles are bucket upper bounds, within 12.5% of the true value.
+ * Pass ALLOC_ALL_SIZE_CLASSES to aggregate over size classes. Queries
+ * with an out-of-range op, path or size class return 0.
+ */
+#define ALLOC_OP_MALLOC 0
+#define ALLOC_OP_FREE   1
+#define ALLOC_OPS       2
+
+#define ALLOC_PATH_HIT       0      // Free block used whole / freed without merging
+#define ALLOC_PATH_SPLIT     1      // Free block split to fit
+#define ALLOC_PATH_COALESCE  2      // Freed block merged with a neighbour
+#define ALLOC_PATH_FAIL      3      // Out of memory, invalid or double free
+#define ALLOC_PATHS          4
+
+#define ALLOC_ALL_SIZE_CLASSES (-1)
+
+void my_latency_enable(int enabled);
+void my_latency_reset(void);
+uint64_t my_latency_count(int op, int path, int size_class);
+uint64_t my_latency_percentile(int op, int path, int size_class, double percentile);
+void print_latency_histograms(void);
+
+// Per-operation trace output is on by default; turn it off before measuring
+void my_allocator_set_verbose(int enabled);
+
+/*
+ * Persistent heap (dynamic allocator only)
+ *
+ * init_allocator_persistent() maps a heap file instead of anonymous memory.
+ * It returns one of the ALLOC_PERSIST_* codes below.
+ */
+#define ALLOC_PERSIST_ERROR           (-1)
+#define ALLOC_PERSIST_CREATED          0    // New, empty heap file
+#define ALLOC_PERSIST_RECOVERED        1    // Previous owner shut down cleanly
+#define ALLOC_PERSIST_RECOVERED_DIRTY  2    // Previous owner crashed
+
+int init_allocator_persistent(const char* path);
+void my_set_root(void* ptr);
+void* my_get_root(void);
+uint64_t my_pool_generation(void);
+
+/*
+ * Shared heap (dynamic allocator only)
+ *
+ * init_allocator_shared() puts the pool in shared memory so several
+ * processes can allocate and free in it. `name` is a shm_open() name;
+ * NULL makes an anonymous memfd pool that forked children inherit.
+ * Attaching to a name whose creator never finished setting it up fails
+ * after a timeout. If a process dies mid-operation and leaves the heap
+ * inconsistent, the pool becomes unusable: allocations return NULL and
+ * frees are refused, in every process.
+ */
+#define ALLOC_SHARED_ERROR    (-1)
+#define ALLOC_SHARED_CREATED   0
+#define ALLOC_SHARED_ATTACHED  1
+
+int init_allocator_shared(const char* name);
+
+// Named heaps persist in /dev/shm until unlinked; the creator should do it
+int my_shared_unlink(const char* name);
+
+// Pool-relative offsets stay valid when the heap is mapped at another address
+size_t my_to_offset(const void* ptr);
+void* my_from_offset(size_t offset);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
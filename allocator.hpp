@@ -0,0 +1,99 @@
+#ifndef ALLOCATOR_HPP
+#define ALLOCATOR_HPP
+
+/*
+ * C++ adapters over the dynamic allocator (header-only, C++17)
+ *
+ * - heap_allocator<T>        standard allocator for std:: containers
+ * - heap_memory_resource()   std::pmr::memory_resource singleton
+ * - heap_monotonic_resource  bump allocator whose chunks come from the heap
+ *
+ * All of them forward size and alignment, so frees go through
+ * my_free_aligned_sized() and over-aligned types get aligned blocks.
+ */
+
+#include <cstddef>
+#include <limits>
+#include <memory_resource>
+#include <new>
+
+#include "allocator.h"
+
+namespace my_allocator {
+
+// Shared by the adapters: allocate `bytes` aligned to `alignment` or throw
+inline void* heap_allocate(std::size_t bytes, std::size_t alignment) {
+    if (bytes == 0) bytes = 1;      // my_malloc(0) returns NULL
+    void* ptr = my_aligned_alloc(alignment, bytes);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+
+inline void heap_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) noexcept {
+    my_free_aligned_sized(ptr, alignment, bytes == 0 ? 1 : bytes);
+}
+
+template <typename T>
+class heap_allocator {
+public:
+    using value_type = T;
+
+    heap_allocator() noexcept = default;
+
+    template <typename U>
+    heap_allocator(const heap_allocator<U>&) noexcept {}
+
+    T* allocate(std::size_t n) {
+        if (n > std::numeric_limits<std::size_t>::max() / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        return static_cast<T*>(heap_allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* ptr, std::size_t n) noexcept {
+        heap_deallocate(ptr, n * sizeof(T), alignof(T));
+    }
+};
+
+// There is a single heap, so any two instances can free each other's memory
+template <typename T, typename U>
+bool operator==(const heap_allocator<T>&, const heap_allocator<U>&) noexcept { return true; }
+
+template <typename T, typename U>
+bool operator!=(const heap_allocator<T>&, const heap_allocator<U>&) noexcept { return false; }
+
+class heap_resource : public std::pmr::memory_resource {
+protected:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        return heap_allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) override {
+        heap_deallocate(ptr, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return dynamic_cast<const heap_resource*>(&other) != nullptr;
+    }
+};
+
+// Counterpart of std::pmr::new_delete_resource()
+inline std::pmr::memory_resource* heap_memory_resource() noexcept {
+    static heap_resource resource;
+    return &resource;
+}
+
+/*
+ * Monotonic buffer over the heap: allocations are pointer bumps inside
+ * chunks taken from the pool, frees are no-ops, and every chunk goes
+ * back to the pool at release() or destruction.
+ */
+class heap_monotonic_resource : public std::pmr::monotonic_buffer_resource {
+public:
+    explicit heap_monotonic_resource(std::size_t initial_size = 1024)
+        : std::pmr::monotonic_buffer_resource(initial_size, heap_memory_resource()) {}
+};
+
+} // namespace my_allocator
+
+#endif
@@ -1,207 +1,1173 @@
-#include <stdio.h>
-#include <stdint.h>
-#include <sys/mman.h>
-#include <unistd.h>
-#include <error.h>
-#include "allocator.h"
-
-#define POOL_SIZE 1024 * 1024       // 1MB memory pool
-#define MIN_BLOCK_SIZE 32
-#define BLOCK_MAGIC 0xDEADBEEF
-#define FREED_MAGIC 0xFEEDFACE
-#define CANARY_VALUE 0xDEADC0DE
-#define ALIGNMENT 8
-
-
-typedef struct block_header {
-    unsigned int magic;
-    uint8_t is_free;
-    uint8_t padding[3];         // 3 bytes explicit padding.
-    size_t size;
-    struct block_header* next;  // Pointer to next block in the list
-} block_header_t;
-
-
-static void* memory_pool = NULL;
-static block_header_t* free_list_head = NULL;
-static int initialized = 0; // False
-
-size_t align_size(size_t size) {
-    return (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
-}
-
-void init_allocator() {
-    if (!initialized) return;
-
-    printf("[INIT] Requesting %zu bytes from OS via mmap()...\n", (size_t)POOL_SIZE);
-
-    // Request memory from OS
-    memory_pool = mmap(
-        NULL,
-        POOL_SIZE,
-        PROT_READ | PROT_WRITE,
-        MAP_PRIVATE | MAP_ANONYMOUS,
-        -1,
-        0
-    );
-
-    if (memory_pool == MAP_FAILED) {
-        perror("[ERROR] mmap failed");
-        memory_pool = NULL;
-        return;
-    }
-
-    printf("[INIT] Successfully allocated memory at %p\n", memory_pool);
-
-    free_list_head = (block_header_t*)memory_pool;
-    free_list_head->size = POOL_SIZE - sizeof(block_header_t);
-    free_list_head->is_free = 1;
-    free_list_head->next = NULL;
-    free_list_head->magic = FREED_MAGIC;
-
-    initialized = 1;
-    printf("[INIT] Allocator initialized with %zu bytes\n", free_list_head->size);
-}
-
-void cleanup_allocator(void) {
-    if (memory_pool && memory_pool != MAP_FAILED) {
-        printf("[CLEANUP] Returning memory to OS via munmap()...\n");
-        if (munmap(memory_pool, POOL_SIZE) == -1) {
-            perror("[ERROR] munmap failed");
-        } else {
-            printf("[CLEANUP] Memory successfully returned to OS\n");
-        }
-        memory_pool = NULL;
-        free_list_head = NULL;
-        initialized = 0;
-    }
-}
-
-void* my_malloc(size_t size) {
-    if (!initialized) init_allocator();
-    if (size == 0) return NULL;
-
-    size = align_size(size);
-    size_t actual_size = size + sizeof(unsigned int);
-    actual_size = align_size(actual_size);
-
-    block_header_t* current = free_list_head;
-
-    // First-fit strategy: find first block that's big enough.
-    while (current != NULL) {
-        if (current ->is_free && current->size >= actual_size) {
-            printf("[ALLOC] Found free block: size=%zu at %p\n", current->size, (void*)current);
-
-            // Should block be split?
-            // Only split if remaining space is useful (> MIN_BLOCK_SIZE)
-            if (current->size >= actual_size + sizeof(block_header_t) + MIN_BLOCK_SIZE) {
-                block_header_t* new_block = (block_header_t*) ((char*)current + sizeof(block_header_t) + actual_size);
-
-                new_block->size = current->size - actual_size - sizeof(block_header_t);
-                new_block->is_free = 1; // True
-                new_block->next = current->next;
-                new_block->magic = FREED_MAGIC;
-
-                // Update current block
-                current->size = actual_size;
-                current->next = new_block;
-
-                printf("[SPLIT] Split block: allocated=%zu, remaining=%zu\n", size, new_block->size);
-            }
-            current->is_free = 0;
-            current->magic = BLOCK_MAGIC; // Valid allocated Block.
-
-            // Return pointer to data area (skip header)
-            void* ptr = (char*)current + sizeof(block_header_t);
-
-            // Place canary at the END of the user's data
-            unsigned int* end_canary = (unsigned int*)((char*)ptr + size);
-            *end_canary = CANARY_VALUE;
-
-            printf("[ALLOC] Returning pointer %p (canary placed at offset %zu)\n", ptr, size);
-            return ptr;
-        }
-        current = current->next;
-    }
-    printf("[ALLOC] FAILED: No suitable block found for size %zu\n", size);
-    return NULL;
-}
-
-void my_free(void* ptr) {
-    if (!ptr) return;
-
-    printf("[FREE] Freeing pointer %p\n", ptr);
-
-    // Get header from user pointer
-    block_header_t* header = (block_header_t*) ((char*)ptr - sizeof(block_header_t));
-
-    if (header->magic == FREED_MAGIC) {
-        printf("[ERROR] Double free detected at %p!\n", ptr);
-        return;
-    }
-
-    if (header->magic != BLOCK_MAGIC) {
-        printf("[ERROR] Invalid pointer passed to my_free: %p\n", ptr);
-        return;
-    }
-
-    // Check end canary for buffer overflow
-    unsigned int* end_canary = (unsigned int*)((char*)ptr + header->size - sizeof(unsigned int));
-    if (*end_canary != CANARY_VALUE) {
-        printf("[ERROR] Buffer overflow detected at %p! Canary was 0x%X, expected 0x%X\n",ptr, *end_canary, CANARY_VALUE);
-        // Continue to free, but user knows there was corruption.
-    } else {
-        printf("[CANARY] Buffer overflow check passed\n");
-    }
-
-    header->magic = FREED_MAGIC;
-    header->is_free = 1;
-
-    // Coalesce with next block if it's free
-    if (header->next && header->next->is_free) {
-        printf("[COALESCE] Merging with next block: %zu + %zu\n", header->size, header->next->size);
-        header->size += sizeof(block_header_t) + header->next->size;
-        header->next = header->next->next;
-    }
-
-    // Coalesce with previous block if it's free
-    // Need to find previous block by walking from head
-    block_header_t* current = free_list_head;
-    while (current && current->next != header) {
-        current = current->next;
-    }
-
-    if (current && current->is_free) {
-        printf("[COALESCE] Merging with previous block: %zu + %zu\n", current->size, header->size);
-        current->size += sizeof(block_header_t) + header->size;
-        current->next = header->next;
-    }
-}
-
-void print_memory_state() {
-    printf("\n=== Memory State ===\n");
-    block_header_t* current = free_list_head;
-    int block_num = 0;
-    size_t total_free = 0;
-    size_t total_allocated = 0;
-
-    while (current != NULL) {
-        printf("Block %d: size=%zu, %s, addr=%p\n",
-            block_num++,
-            current->size,
-            current->is_free ? "FREE" : "ALLOCATED",
-            (void*)current);
-
-        if (current->is_free) {
-            total_free += current->size;
-        } else {
-            total_allocated += current->size;
-        }
-
-        current = current->next;
-    }
-
-    printf("Total free: %zu bytes\n", total_free);
-    printf("Total used: %zu bytes\n", total_allocated);
-    printf("===================\n\n");
-}
\ No newline at end of file
+#define _GNU_SOURCE                 // MAP_ANONYMOUS and memfd_create under -std=c11
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <error.h>
+#include "allocator.h"
+
+#define POOL_SIZE 1024 * 1024       // 1MB memory pool
+#define MIN_BLOCK_SIZE 32
+#define BLOCK_MAGIC 0xDEADBEEF
+#define FREED_MAGIC 0xFEEDFACE
+#define CANARY_VALUE 0xDEADC0DE
+#define ALIGNMENT 8
+#define POOL_MAGIC 0x4C4F4F50       // "POOL"
+#define POOL_VERSION 4
+#define HOT_REGION_SIZE (POOL_SIZE / 16)  // Bottom of the heap reserved for ALLOC_HOT
+
+// Where the pool's pages come from
+#define POOL_ANONYMOUS 0            // Private mmap, gone at cleanup
+#define POOL_FILE 1                 // Heap file, survives restarts
+#define POOL_SHARED 2               // Shared memory object, mapped by several processes
+
+#define SHARED_ATTACH_TIMEOUT_MS 1000   // How long an attacher waits for the creator to format
+
+
+/*
+ * Pool header, stored at offset 0 of the pool.
+ *
+ * Everything the allocator needs to resume lives inside the pool itself,
+ * so a file-backed pool can be remapped at a different address by a new
+ * process. All links are offsets from the start of the pool; offset 0 is
+ * the pool header, so it doubles as the NULL offset.
+ *
+ * The lock is a process-shared, robust mutex so several processes can map
+ * the same pool, and a process dying mid-operation does not wedge the rest.
+ */
+typedef struct pool_header {
+    unsigned int magic;
+    unsigned int version;
+    uint64_t generation;        // Bumped every time the pool is opened
+    uint8_t clean_shutdown;     // Cleared while mapped, set by cleanup_allocator()
+    uint8_t padding[7];
+    size_t pool_size;
+    size_t heap_offset;         // Offset of the first block header
+    size_t root_offset;         // Offset of the root object's data (0 = none)
+    size_t hot_end;             // End of the ALLOC_HOT region
+    pthread_mutex_t lock;       // Guards the block list
+} pool_header_t;
+
+typedef struct block_header {
+    unsigned int magic;
+    uint8_t is_free;
+    uint8_t requested[3];       // Size the caller asked for, 24-bit little endian (fills the padding)
+    size_t size;
+    size_t next;                // Pool offset of next block in the list (0 = end)
+} block_header_t;
+
+
+static void* memory_pool = NULL;
+static pool_header_t* pool = NULL;
+static block_header_t* free_list_head = NULL;
+static int pool_fd = -1;        // Backing file or shared memory object, -1 for anonymous pools
+static int pool_mode = POOL_ANONYMOUS;
+static int initialized = 0; // False
+static int verbose = 1;         // Trace every allocation and free
+
+// Per-operation trace lines; errors are always printed
+#define TRACE(...) do { if (verbose) printf(__VA_ARGS__); } while (0)
+
+size_t align_size(size_t size) {
+    return (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+}
+
+// Offset <-> pointer conversion, only valid while the pool is mapped
+static block_header_t* block_at(size_t offset) {
+    return offset ? (block_header_t*)((char*)memory_pool + offset) : NULL;
+}
+
+static size_t offset_of(const void* ptr) {
+    return ptr ? (size_t)((const char*)ptr - (const char*)memory_pool) : 0;
+}
+
+// malloc_unlocked() refuses sizes over POOL_SIZE, so requested sizes fit the header's 24 bits
+_Static_assert(POOL_SIZE < (1 << 24), "requested size must fit in 24 bits");
+
+static void set_requested_size(block_header_t* block, size_t size) {
+    block->requested[0] = size & 0xFF;
+    block->requested[1] = (size >> 8) & 0xFF;
+    block->requested[2] = (size >> 16) & 0xFF;
+}
+
+static size_t requested_size(const block_header_t* block) {
+    return block->requested[0] | (block->requested[1] << 8) | ((size_t)block->requested[2] << 16);
+}
+
+// Could `ptr` be the data of a block? Pointers into the pool header cannot.
+static int in_pool(const void* ptr) {
+    return memory_pool &&
+           (const char*)ptr >= (const char*)memory_pool + pool->heap_offset + sizeof(block_header_t) &&
+           (const char*)ptr < (const char*)memory_pool + POOL_SIZE;
+}
+
+// CLOCK_MONOTONIC is served from the vDSO, so this does not enter the kernel
+static uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void init_pool_lock(void) {
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+    pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+    pthread_mutex_init(&pool->lock, &attr);
+    pthread_mutexattr_destroy(&attr);
+}
+
+static int check_heap(void);
+
+/*
+ * Returns 1 with the pool locked, or 0 if the pool is unusable.
+ *
+ * If the previous holder died, the heap is checked before the lock is
+ * made consistent again. When the check fails the lock is released
+ * without pthread_mutex_consistent(), which makes it permanently
+ * ENOTRECOVERABLE: every later operation, in every process mapping the
+ * pool, fails instead of working on a broken heap.
+ */
+static int lock_pool(void) {
+    int error = pthread_mutex_lock(&pool->lock);
+    if (error == EOWNERDEAD) {
+        // The previous holder died; whatever it was doing may be half done
+        printf("[LOCK] Previous lock owner died, recovering lock\n");
+        if (!check_heap()) {
+            printf("[ERROR] Heap left inconsistent by dead lock owner, pool is unusable\n");
+            pthread_mutex_unlock(&pool->lock);
+            return 0;
+        }
+        pthread_mutex_consistent(&pool->lock);
+        error = 0;
+    }
+    if (error == ENOTRECOVERABLE) {
+        printf("[ERROR] Pool is unusable: heap was left inconsistent\n");
+        return 0;
+    }
+    if (error != 0) {
+        printf("[ERROR] Locking the pool failed: %s\n", strerror(error));
+        return 0;
+    }
+    return 1;
+}
+
+static void unlock_pool(void) {
+    pthread_mutex_unlock(&pool->lock);
+}
+
+// Lay out an empty heap: pool header followed by one big free block.
+// The magic is published last so attaching processes never see a half-formatted pool.
+static void format_pool(void) {
+    pool->version = POOL_VERSION;
+    pool->generation = 0;
+    pool->clean_shutdown = 0;
+    pool->pool_size = POOL_SIZE;
+    pool->heap_offset = align_size(sizeof(pool_header_t));
+    pool->root_offset = 0;
+    pool->hot_end = pool->heap_offset + HOT_REGION_SIZE;
+
+    block_header_t* first = block_at(pool->heap_offset);
+    first->size = POOL_SIZE - pool->heap_offset - sizeof(block_header_t);
+    first->is_free = 1;
+    first->next = 0;
+    first->magic = FREED_MAGIC;
+
+    init_pool_lock();
+    __atomic_store_n(&pool->magic, POOL_MAGIC, __ATOMIC_RELEASE);
+}
+
+// Walk the block list and make sure it exactly tiles the pool
+static int check_heap(void) {
+    size_t expected = pool->heap_offset;
+    block_header_t* current = block_at(pool->heap_offset);
+
+    while (current != NULL) {
+        if (offset_of(current) != expected) return 0;
+        if (current->magic != BLOCK_MAGIC && current->magic != FREED_MAGIC) return 0;
+        if (current->is_free != (current->magic == FREED_MAGIC)) return 0;
+        if (current->size > POOL_SIZE - expected - sizeof(block_header_t)) return 0;
+
+        expected += sizeof(block_header_t) + current->size;
+        current = block_at(current->next);
+    }
+    return expected == POOL_SIZE;
+}
+
+void init_allocator() {
+    if (initialized) return;
+
+    printf("[INIT] Requesting %zu bytes from OS via mmap()...\n", (size_t)POOL_SIZE);
+
+    // Request memory from OS
+    memory_pool = mmap(
+        NULL,
+        POOL_SIZE,
+        PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS,
+        -1,
+        0
+    );
+
+    if (memory_pool == MAP_FAILED) {
+        perror("[ERROR] mmap failed");
+        memory_pool = NULL;
+        return;
+    }
+
+    printf("[INIT] Successfully allocated memory at %p\n", memory_pool);
+
+    pool = (pool_header_t*)memory_pool;
+    format_pool();
+    free_list_head = block_at(pool->heap_offset);
+
+    initialized = 1;
+    printf("[INIT] Allocator initialized with %zu bytes\n", free_list_head->size);
+}
+
+/*
+ * Open (or create) a file-backed heap at `path`.
+ *
+ * The pool is a MAP_SHARED mapping of the file, so allocations written by
+ * one run are still there for the next one. Every open bumps the header
+ * generation and clears the clean-shutdown flag; cleanup_allocator() sets
+ * it again after flushing. Finding the flag cleared on open means the
+ * previous owner died without cleaning up. A file whose creator died
+ * before formatting it is formatted afresh and reported as created.
+ *
+ * Only one process may have a heap file open at a time: the file is
+ * flock()ed for as long as it is mapped, and opening a held file fails.
+ */
+int init_allocator_persistent(const char* path) {
+    if (initialized) {
+        printf("[ERROR] Allocator already initialized\n");
+        return ALLOC_PERSIST_ERROR;
+    }
+
+    printf("[INIT] Opening persistent heap %s...\n", path);
+
+    int fd = open(path, O_RDWR | O_CREAT, 0600);
+    if (fd == -1) {
+        perror("[ERROR] open failed");
+        return ALLOC_PERSIST_ERROR;
+    }
+
+    // Released by close() in cleanup_allocator(), or by the kernel if we die
+    if (flock(fd, LOCK_EX | LOCK_NB) == -1) {
+        if (errno == EWOULDBLOCK) {
+            printf("[ERROR] %s is already in use by another process\n", path);
+        } else {
+            perror("[ERROR] flock failed");
+        }
+        close(fd);
+        return ALLOC_PERSIST_ERROR;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+        perror("[ERROR] fstat failed");
+        close(fd);
+        return ALLOC_PERSIST_ERROR;
+    }
+
+    int fresh = (st.st_size == 0);
+    if (fresh && ftruncate(fd, POOL_SIZE) == -1) {
+        perror("[ERROR] ftruncate failed");
+        close(fd);
+        return ALLOC_PERSIST_ERROR;
+    }
+    if (!fresh && st.st_size != POOL_SIZE) {
+        printf("[ERROR] %s is %lld bytes, expected %zu\n", path, (long long)st.st_size, (size_t)POOL_SIZE);
+        close(fd);
+        return ALLOC_PERSIST_ERROR;
+    }
+
+    memory_pool = mmap(NULL, POOL_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (memory_pool == MAP_FAILED) {
+        perror("[ERROR] mmap failed");
+        memory_pool = NULL;
+        close(fd);
+        return ALLOC_PERSIST_ERROR;
+    }
+    pool = (pool_header_t*)memory_pool;
+
+    // format_pool() publishes the magic last, so a creator that died after
+    // ftruncate() left a sized file with no magic: format it as a new one
+    if (!fresh && pool->magic == 0) {
+        printf("[INIT] %s was never formatted, formatting it now\n", path);
+        fresh = 1;
+    }
+
+    int status;
+    if (fresh) {
+        format_pool();
+        msync(memory_pool, POOL_SIZE, MS_SYNC);
+        status = ALLOC_PERSIST_CREATED;
+        printf("[INIT] Created new persistent heap at %p\n", memory_pool);
+    } else {
+        if (pool->magic != POOL_MAGIC || pool->version != POOL_VERSION || pool->pool_size != POOL_SIZE) {
+            printf("[ERROR] %s is not a compatible heap file\n", path);
+            munmap(memory_pool, POOL_SIZE);
+            memory_pool = NULL;
+            pool = NULL;
+            close(fd);
+            return ALLOC_PERSIST_ERROR;
+        }
+        if (!check_heap()) {
+            printf("[ERROR] Heap in %s is corrupted\n", path);
+            munmap(memory_pool, POOL_SIZE);
+            memory_pool = NULL;
+            pool = NULL;
+            close(fd);
+            return ALLOC_PERSIST_ERROR;
+        }
+        // We hold the flock, so nobody else has the file mapped and any lock state in it is stale
+        init_pool_lock();
+        status = pool->clean_shutdown ? ALLOC_PERSIST_RECOVERED : ALLOC_PERSIST_RECOVERED_DIRTY;
+        printf("[INIT] Recovered persistent heap at %p (generation %llu, %s shutdown)\n",
+            memory_pool, (unsigned long long)pool->generation,
+            pool->clean_shutdown ? "clean" : "UNCLEAN");
+    }
+
+    pool->generation++;
+    pool->clean_shutdown = 0;
+    msync(memory_pool, sizeof(pool_header_t), MS_SYNC);
+
+    pool_fd = fd;
+    pool_mode = POOL_FILE;
+    free_list_head = block_at(pool->heap_offset);
+    initialized = 1;
+    return status;
+}
+
+/*
+ * Create or attach to a heap in shared memory.
+ *
+ * With a name, the pool is the POSIX shared memory object `name`
+ * (shm_open), and unrelated processes attach by opening the same name.
+ * With NULL, the pool is an anonymous memfd that children forked after
+ * this call inherit. Either way the mapping is MAP_SHARED, so a block
+ * allocated in one process can be read and freed in another; pass
+ * my_to_offset() values between processes since the pool may map at
+ * different addresses.
+ *
+ * An attacher gives up after SHARED_ATTACH_TIMEOUT_MS if the object is
+ * never sized and formatted, e.g. because its creator died half way.
+ * Named objects outlive every process; remove them with my_shared_unlink().
+ */
+int init_allocator_shared(const char* name) {
+    if (initialized) {
+        printf("[ERROR] Allocator already initialized\n");
+        return ALLOC_SHARED_ERROR;
+    }
+
+    int fd;
+    int creator = 1;
+    if (name) {
+        printf("[INIT] Opening shared heap %s...\n", name);
+        fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd == -1 && errno == EEXIST) {
+            fd = shm_open(name, O_RDWR, 0600);
+            creator = 0;
+        }
+    } else {
+        printf("[INIT] Creating anonymous shared heap...\n");
+        fd = memfd_create("my_allocator", MFD_CLOEXEC);
+    }
+    if (fd == -1) {
+        perror("[ERROR] Shared memory open failed");
+        return ALLOC_SHARED_ERROR;
+    }
+
+    if (creator) {
+        if (ftruncate(fd, POOL_SIZE) == -1) {
+            perror("[ERROR] ftruncate failed");
+            close(fd);
+            return ALLOC_SHARED_ERROR;
+        }
+    } else {
+        // The creator may not have sized the object yet
+        struct stat st;
+        uint64_t deadline = monotonic_ns() + SHARED_ATTACH_TIMEOUT_MS * 1000000ull;
+        for (;;) {
+            if (fstat(fd, &st) == -1) {
+                perror("[ERROR] fstat failed");
+                close(fd);
+                return ALLOC_SHARED_ERROR;
+            }
+            if (st.st_size != 0 || monotonic_ns() >= deadline) break;
+            sched_yield();
+        }
+        if (st.st_size != POOL_SIZE) {
+            printf("[ERROR] Shared heap %s is %lld bytes, expected %zu\n", name, (long long)st.st_size, (size_t)POOL_SIZE);
+            close(fd);
+            return ALLOC_SHARED_ERROR;
+        }
+    }
+
+    memory_pool = mmap(NULL, POOL_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (memory_pool == MAP_FAILED) {
+        perror("[ERROR] mmap failed");
+        memory_pool = NULL;
+        close(fd);
+        return ALLOC_SHARED_ERROR;
+    }
+    pool = (pool_header_t*)memory_pool;
+
+    if (creator) {
+        format_pool();
+        printf("[INIT] Created shared heap at %p\n", memory_pool);
+    } else {
+        // Wait for the creator to finish formatting
+        uint64_t deadline = monotonic_ns() + SHARED_ATTACH_TIMEOUT_MS * 1000000ull;
+        while (__atomic_load_n(&pool->magic, __ATOMIC_ACQUIRE) != POOL_MAGIC && monotonic_ns() < deadline) {
+            sched_yield();
+        }
+        if (__atomic_load_n(&pool->magic, __ATOMIC_ACQUIRE) != POOL_MAGIC) {
+            printf("[ERROR] Shared heap %s was never formatted (creator died?)\n", name);
+            munmap(memory_pool, POOL_SIZE);
+            memory_pool = NULL;
+            pool = NULL;
+            close(fd);
+            return ALLOC_SHARED_ERROR;
+        }
+        if (pool->version != POOL_VERSION || pool->pool_size != POOL_SIZE) {
+            printf("[ERROR] %s is not a compatible shared heap\n", name);
+            munmap(memory_pool, POOL_SIZE);
+            memory_pool = NULL;
+            pool = NULL;
+            close(fd);
+            return ALLOC_SHARED_ERROR;
+        }
+        printf("[INIT] Attached to shared heap at %p\n", memory_pool);
+    }
+
+    pool_fd = fd;
+    pool_mode = POOL_SHARED;
+    free_list_head = block_at(pool->heap_offset);
+    initialized = 1;
+    return creator ? ALLOC_SHARED_CREATED : ALLOC_SHARED_ATTACHED;
+}
+
+/*
+ * Remove a named shared heap. Processes that have it mapped keep using it
+ * until their cleanup_allocator(); new attaches create a fresh heap.
+ * Call it from whichever process owns the heap's lifetime, usually the creator.
+ */
+int my_shared_unlink(const char* name) {
+    if (shm_unlink(name) == -1) {
+        perror("[ERROR] shm_unlink failed");
+        return -1;
+    }
+    printf("[CLEANUP] Removed shared heap %s\n", name);
+    return 0;
+}
+
+void cleanup_allocator(void) {
+    if (memory_pool && memory_pool != MAP_FAILED) {
+        if (pool_mode == POOL_FILE) {
+            // Flush the heap first, then publish the clean-shutdown flag
+            printf("[CLEANUP] Flushing persistent heap...\n");
+            msync(memory_pool, POOL_SIZE, MS_SYNC);
+            pool->clean_shutdown = 1;
+            msync(memory_pool, sizeof(pool_header_t), MS_SYNC);
+        }
+        printf("[CLEANUP] Returning memory to OS via munmap()...\n");
+        if (munmap(memory_pool, POOL_SIZE) == -1) {
+            perror("[ERROR] munmap failed");
+        } else {
+            printf("[CLEANUP] Memory successfully returned to OS\n");
+        }
+        if (pool_fd != -1) {
+            close(pool_fd);
+            pool_fd = -1;
+        }
+        memory_pool = NULL;
+        pool = NULL;
+        free_list_head = NULL;
+        pool_mode = POOL_ANONYMOUS;
+        initialized = 0;
+    }
+}
+
+/*
+ * Latency histograms
+ *
+ * Log-linear buckets, HDR-style: values below 2 * LATENCY_SUB_BUCKETS get
+ * a bucket each, above that every power of two is cut into
+ * LATENCY_SUB_BUCKETS equal slices (12.5% resolution). One histogram per
+ * operation, path and size class, where the size class always comes from
+ * the size the caller requested (for frees: the size it was allocated
+ * with), never the block's capacity; counters are bumped with relaxed
+ * atomics so recording never takes a lock. Histograms are per process,
+ * even on a shared heap.
+ */
+#define LATENCY_SUB_BITS 3
+#define LATENCY_SUB_BUCKETS (1 << LATENCY_SUB_BITS)
+#define LATENCY_MAX_BITS 36         // Values are clamped to 2^36 - 1 (~69 s in ns)
+#define LATENCY_BUCKETS ((LATENCY_MAX_BITS - LATENCY_SUB_BITS + 1) * LATENCY_SUB_BUCKETS)
+
+static uint64_t latency_hist[ALLOC_OPS][ALLOC_PATHS][ALLOC_SIZE_CLASSES][LATENCY_BUCKETS];
+static int latency_enabled = 0;
+
+#if defined(ALLOCATOR_LATENCY_RDTSC) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define LATENCY_UNIT "cycles"
+static uint64_t latency_now(void) {
+    return __rdtsc();
+}
+#else
+#define LATENCY_UNIT "ns"
+static uint64_t latency_now(void) {
+    return monotonic_ns();
+}
+#endif
+
+static int latency_bucket(uint64_t value) {
+    if (value >= (1ull << LATENCY_MAX_BITS)) value = (1ull << LATENCY_MAX_BITS) - 1;
+    if (value < 2 * LATENCY_SUB_BUCKETS) return (int)value;
+
+    int msb = 63 - __builtin_clzll(value);
+    int shift = msb - LATENCY_SUB_BITS;
+    return shift * LATENCY_SUB_BUCKETS + (int)(value >> shift);
+}
+
+// Largest value that lands in `bucket`
+static uint64_t latency_bucket_limit(int bucket) {
+    if (bucket < 2 * LATENCY_SUB_BUCKETS) return (uint64_t)bucket;
+
+    int shift = bucket / LATENCY_SUB_BUCKETS - 1;
+    uint64_t base = (uint64_t)(bucket % LATENCY_SUB_BUCKETS + LATENCY_SUB_BUCKETS);
+    return ((base + 1) << shift) - 1;
+}
+
+size_t my_size_class_bytes(int size_class) {
+    return (size_t)32 << size_class;
+}
+
+static int size_class_of(size_t size) {
+    int size_class = 0;
+    while (size_class < ALLOC_SIZE_CLASSES - 1 && size > my_size_class_bytes(size_class)) {
+        size_class++;
+    }
+    return size_class;
+}
+
+// Start timing an operation; 0 means instrumentation is off
+static uint64_t latency_start(void) {
+    return latency_enabled ? latency_now() : 0;
+}
+
+static void latency_record(int op, int path, size_t size, uint64_t start) {
+    if (start == 0) return;
+    uint64_t elapsed = latency_now() - start;
+    uint64_t* counter = &latency_hist[op][path][size_class_of(size)][latency_bucket(elapsed)];
+    __atomic_fetch_add(counter, 1, __ATOMIC_RELAXED);
+}
+
+/*
+ * Find where in free block `block` an allocation of `actual_size` bytes
+ * can go, staying inside the pool window [lo, hi). Returns the gap
+ * between the block's data and the allocation's data, or -1 if it does
+ * not fit. A non-zero gap is always big enough to leave a useful free
+ * block in front. `from_top` pushes the allocation to the high end.
+ */
+static long place_in_block(block_header_t* block, size_t actual_size, size_t alignment,
+                           uintptr_t lo, uintptr_t hi, int from_top) {
+    uintptr_t data = (uintptr_t)block + sizeof(block_header_t);
+    uintptr_t block_end = data + block->size;
+    uintptr_t window_lo = data > lo + sizeof(block_header_t) ? data : lo + sizeof(block_header_t);
+    uintptr_t window_hi = block_end < hi ? block_end : hi;
+    uintptr_t min_gap = sizeof(block_header_t) + MIN_BLOCK_SIZE;
+
+    if (window_hi < window_lo + actual_size) return -1;
+
+    uintptr_t placed;
+    if (from_top) {
+        placed = (window_hi - actual_size) & ~(uintptr_t)(alignment - 1);
+        if (placed != data && placed - data < min_gap) placed = data;
+        if (placed < window_lo) return -1;
+    } else {
+        placed = (window_lo + alignment - 1) & ~(uintptr_t)(alignment - 1);
+        while (placed != data && placed - data < min_gap) {
+            placed += alignment;
+        }
+        if (placed + actual_size > window_hi) return -1;
+    }
+    return (long)(placed - data);
+}
+
+// Search one pool window for a block: first fit, or last fit when from_top
+static block_header_t* find_block(size_t actual_size, size_t alignment,
+                                  size_t lo, size_t hi, int from_top, long* gap) {
+    uintptr_t window_lo = (uintptr_t)memory_pool + lo;
+    uintptr_t window_hi = (uintptr_t)memory_pool + hi;
+    block_header_t* found = NULL;
+
+    for (block_header_t* current = free_list_head; current != NULL; current = block_at(current->next)) {
+        if ((uintptr_t)current >= window_hi) break;
+        if (!current->is_free || current->size < actual_size) continue;
+
+        long placed = place_in_block(current, actual_size, alignment, window_lo, window_hi, from_top);
+        if (placed < 0) continue;
+
+        found = current;
+        *gap = placed;
+        if (!from_top) break;   // Last fit keeps scanning for a higher block
+    }
+    return found;
+}
+
+static void* malloc_unlocked(size_t size, size_t alignment, int flags, int* path) {
+    // Also keeps align_size() from wrapping and the size within the header's 24 bits
+    if (size > POOL_SIZE) {
+        printf("[ERROR] Request of %zu bytes is larger than the pool\n", size);
+        *path = ALLOC_PATH_FAIL;
+        return NULL;
+    }
+    size_t requested = size;
+    size = align_size(size);
+    size_t actual_size = size + sizeof(unsigned int);
+    actual_size = align_size(actual_size);
+
+    block_header_t* current = NULL;
+    long gap = 0;
+
+    /*
+     * Lifetime hints pick a region of the pool:
+     * - HOT objects are packed into the hot region at the bottom
+     * - LONG_LIVED and unhinted objects grow upwards from the end of the hot region
+     * - SHORT_LIVED objects grow downwards from the top of the pool
+     * so temporaries do not end up pinning holes between long-lived data.
+     * When its region is full, a request falls back to first-fit above the
+     * hot region, and only then to the hot region itself.
+     */
+    if (flags & ALLOC_HOT) {
+        current = find_block(actual_size, alignment, pool->heap_offset, pool->hot_end, 0, &gap);
+    }
+    if (!current && (flags & ALLOC_SHORT_LIVED)) {
+        current = find_block(actual_size, alignment, pool->hot_end, POOL_SIZE, 1, &gap);
+    }
+    // First-fit strategy: find first block that's big enough.
+    if (!current) {
+        current = find_block(actual_size, alignment, pool->hot_end, POOL_SIZE, 0, &gap);
+    }
+    if (!current) {
+        current = find_block(actual_size, alignment, 0, POOL_SIZE, 0, &gap);
+    }
+
+    if (current == NULL) {
+        TRACE("[ALLOC] FAILED: No suitable block found for size %zu\n", size);
+        *path = ALLOC_PATH_FAIL;
+        return NULL;
+    }
+    *path = gap > 0 ? ALLOC_PATH_SPLIT : ALLOC_PATH_HIT;
+
+    TRACE("[ALLOC] Found free block: size=%zu at %p\n", current->size, (void*)current);
+
+    // Allocation does not start at the block: split off the front as its own free block
+    if (gap > 0) {
+        block_header_t* placed_block = (block_header_t*) ((char*)current + gap);
+
+        placed_block->size = current->size - gap;
+        placed_block->is_free = 1;
+        placed_block->next = current->next;
+        placed_block->magic = FREED_MAGIC;
+
+        current->size = gap - sizeof(block_header_t);
+        current->next = offset_of(placed_block);
+        current = placed_block;
+
+        TRACE("[PLACE] Skipped %ld bytes into the block\n", gap);
+    }
+
+    // Should block be split?
+    // Only split if remaining space is useful (> MIN_BLOCK_SIZE)
+    if (current->size >= actual_size + sizeof(block_header_t) + MIN_BLOCK_SIZE) {
+        block_header_t* new_block = (block_header_t*) ((char*)current + sizeof(block_header_t) + actual_size);
+
+        new_block->size = current->size - actual_size - sizeof(block_header_t);
+        new_block->is_free = 1; // True
+        new_block->next = current->next;
+        new_block->magic = FREED_MAGIC;
+
+        // Update current block
+        current->size = actual_size;
+        current->next = offset_of(new_block);
+        *path = ALLOC_PATH_SPLIT;
+
+        TRACE("[SPLIT] Split block: allocated=%zu, remaining=%zu\n", size, new_block->size);
+    }
+    current->is_free = 0;
+    current->magic = BLOCK_MAGIC; // Valid allocated Block.
+
+    // Return pointer to data area (skip header)
+    void* ptr = (char*)current + sizeof(block_header_t);
+
+    // Place canary right after the user's data; it may be unaligned
+    unsigned int canary = CANARY_VALUE;
+    set_requested_size(current, requested);
+    memcpy((char*)ptr + requested, &canary, sizeof(canary));
+
+    TRACE("[ALLOC] Returning pointer %p (canary placed at offset %zu)\n", ptr, requested);
+    return ptr;
+}
+
+// Lock, allocate and record the latency; NULL if the pool is unusable
+static void* malloc_timed(size_t size, size_t alignment, int flags) {
+    uint64_t start = latency_start();
+    int path = ALLOC_PATH_FAIL;
+    void* ptr = NULL;
+    if (lock_pool()) {
+        ptr = malloc_unlocked(size, alignment, flags, &path);
+        unlock_pool();
+    }
+    latency_record(ALLOC_OP_MALLOC, path, size, start);
+    return ptr;
+}
+
+void* my_malloc(size_t size) {
+    if (!initialized) init_allocator();
+    if (!initialized) return NULL;
+    if (size == 0) return NULL;
+
+    return malloc_timed(size, ALIGNMENT, 0);
+}
+
+// my_malloc() with ALLOC_SHORT_LIVED / ALLOC_LONG_LIVED / ALLOC_HOT placement hints
+void* my_malloc_hint(size_t size, int flags) {
+    if (!initialized) init_allocator();
+    if (!initialized) return NULL;
+    if (size == 0) return NULL;
+
+    return malloc_timed(size, ALIGNMENT, flags);
+}
+
+/*
+ * Allocate with an alignment stronger than ALIGNMENT (a power of two).
+ * The block header still sits right before the data, so the result can
+ * be released with my_free() like any other pointer.
+ */
+void* my_aligned_alloc(size_t alignment, size_t size) {
+    if (!initialized) init_allocator();
+    if (!initialized) return NULL;
+    if (size == 0) return NULL;
+
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0) {
+        printf("[ERROR] Alignment %zu is not a power of two\n", alignment);
+        return NULL;
+    }
+    if (alignment < ALIGNMENT) alignment = ALIGNMENT;
+
+    return malloc_timed(size, alignment, 0);
+}
+
+// Returns the ALLOC_PATH_* taken and the size the block was allocated with
+static int free_unlocked(void* ptr, size_t* freed_size) {
+    // Get header from user pointer
+    block_header_t* header = (block_header_t*) ((char*)ptr - sizeof(block_header_t));
+    int path = ALLOC_PATH_HIT;
+    *freed_size = 0;
+
+    if (header->magic == FREED_MAGIC) {
+        printf("[ERROR] Double free detected at %p!\n", ptr);
+        return ALLOC_PATH_FAIL;
+    }
+
+    if (header->magic != BLOCK_MAGIC) {
+        printf("[ERROR] Invalid pointer passed to my_free: %p\n", ptr);
+        return ALLOC_PATH_FAIL;
+    }
+    *freed_size = requested_size(header);
+
+    // Check end canary for buffer overflow
+    unsigned int end_canary;
+    memcpy(&end_canary, (char*)ptr + requested_size(header), sizeof(end_canary));
+    block_header_t* next = block_at(header->next);
+    int next_intact = !next || next->magic == BLOCK_MAGIC || next->magic == FREED_MAGIC;
+    if (end_canary != CANARY_VALUE) {
+        printf("[ERROR] Buffer overflow detected at %p! Canary was 0x%X, expected 0x%X\n",ptr, end_canary, CANARY_VALUE);
+        // Continue to free, but user knows there was corruption.
+    } else if (!next_intact) {
+        // Overflow skipped the canary and landed in the next block's header
+        printf("[ERROR] Buffer overflow detected at %p! Next block header corrupted (magic 0x%X)\n", ptr, next->magic);
+    } else {
+        TRACE("[CANARY] Buffer overflow check passed\n");
+    }
+
+    // Freeing the root object detaches it
+    if (pool->root_offset == offset_of(ptr)) {
+        pool->root_offset = 0;
+    }
+
+    header->magic = FREED_MAGIC;
+    header->is_free = 1;
+
+    // Coalesce with next block if it's free (and its header can still be trusted)
+    if (next && next_intact && next->is_free) {
+        TRACE("[COALESCE] Merging with next block: %zu + %zu\n", header->size, next->size);
+        header->size += sizeof(block_header_t) + next->size;
+        header->next = next->next;
+        path = ALLOC_PATH_COALESCE;
+    }
+
+    // Coalesce with previous block if it's free
+    // Need to find previous block by walking from head
+    size_t header_offset = offset_of(header);
+    block_header_t* current = free_list_head;
+    while (current && current->next != header_offset) {
+        current = block_at(current->next);
+    }
+
+    if (current && current->is_free) {
+        TRACE("[COALESCE] Merging with previous block: %zu + %zu\n", current->size, header->size);
+        current->size += sizeof(block_header_t) + header->size;
+        current->next = header->next;
+        path = ALLOC_PATH_COALESCE;
+    }
+    return path;
+}
+
+void my_free(void* ptr) {
+    if (!ptr) return;
+
+    TRACE("[FREE] Freeing pointer %p\n", ptr);
+    uint64_t start = latency_start();
+
+    if (!in_pool(ptr)) {
+        printf("[ERROR] Invalid pointer passed to my_free: %p\n", ptr);
+        latency_record(ALLOC_OP_FREE, ALLOC_PATH_FAIL, 0, start);
+        return;
+    }
+
+    if (!lock_pool()) {
+        printf("[ERROR] Not freeing %p\n", ptr);
+        latency_record(ALLOC_OP_FREE, ALLOC_PATH_FAIL, 0, start);
+        return;
+    }
+    size_t freed_size;
+    int path = free_unlocked(ptr, &freed_size);
+    unlock_pool();
+    latency_record(ALLOC_OP_FREE, path, freed_size, start);
+}
+
+/*
+ * Free with the size (and alignment) the caller allocated with, as C++
+ * sized deallocation and std::pmr do. Both are checked against the block
+ * before it is released, catching frees through the wrong type.
+ */
+void my_free_aligned_sized(void* ptr, size_t alignment, size_t size) {
+    if (!ptr) return;
+
+    TRACE("[FREE] Freeing pointer %p (size=%zu, alignment=%zu)\n", ptr, size, alignment);
+    uint64_t start = latency_start();
+
+    if (!in_pool(ptr)) {
+        printf("[ERROR] Invalid pointer passed to my_free: %p\n", ptr);
+        latency_record(ALLOC_OP_FREE, ALLOC_PATH_FAIL, size, start);
+        return;
+    }
+
+    if (alignment && (uintptr_t)ptr % alignment != 0) {
+        printf("[ERROR] Pointer %p is not %zu-byte aligned as claimed\n", ptr, alignment);
+    }
+
+    if (!lock_pool()) {
+        printf("[ERROR] Not freeing %p\n", ptr);
+        latency_record(ALLOC_OP_FREE, ALLOC_PATH_FAIL, size, start);
+        return;
+    }
+    block_header_t* header = (block_header_t*) ((char*)ptr - sizeof(block_header_t));
+    if (header->magic == BLOCK_MAGIC && size != requested_size(header)) {
+        printf("[ERROR] Sized free of %zu bytes at %p, but %zu were allocated\n",
+            size, ptr, requested_size(header));
+    }
+    size_t freed_size;
+    int path = free_unlocked(ptr, &freed_size);
+    unlock_pool();
+    latency_record(ALLOC_OP_FREE, path, freed_size, start);
+}
+
+void my_free_sized(void* ptr, size_t size) {
+    my_free_aligned_sized(ptr, 0, size);
+}
+
+/*
+ * Get the pool to steady state before latency matters.
+ *
+ * Prefaults the first `bytes` of the pool (0 = all of it), with
+ * MADV_POPULATE_WRITE where the kernel has it and by touching every page
+ * otherwise. Pages are touched with an atomic add of zero so this is safe
+ * on a shared heap other processes are writing to. ALLOC_WARMUP_MLOCK
+ * also pins them.
+ *
+ * per_size_class_counts[i] (may be NULL) free blocks of
+ * my_size_class_bytes(i) are then carved, smallest class first, with the
+ * same first-fit placement as my_malloc(): into the lowest free space
+ * above the hot region, which on a used heap means existing holes first.
+ * Later first-fit requests then take them whole without splitting.
+ * They stay carved for good: my_free() only merges a block with its
+ * immediate neighbours, so a run of unused carved blocks never joins
+ * back into one. If the pool fills up before every block is carved,
+ * nothing is left carved and -1 is returned.
+ */
+int my_allocator_warmup(size_t bytes, const size_t* per_size_class_counts, int flags) {
+    if (!initialized) init_allocator();
+    if (!initialized) return -1;
+
+    int result = 0;
+    if (bytes == 0 || bytes > POOL_SIZE) bytes = POOL_SIZE;
+
+    printf("[WARMUP] Prefaulting %zu bytes of the pool...\n", bytes);
+    int populated = 0;
+#ifdef MADV_POPULATE_WRITE
+    populated = madvise(memory_pool, bytes, MADV_POPULATE_WRITE) == 0;
+#endif
+    if (!populated) {
+        long page_size = sysconf(_SC_PAGESIZE);
+        for (size_t offset = 0; offset < bytes; offset += page_size) {
+            __atomic_fetch_add((char*)memory_pool + offset, 0, __ATOMIC_RELAXED);
+        }
+    }
+
+    if ((flags & ALLOC_WARMUP_MLOCK) && mlock(memory_pool, bytes) == -1) {
+        perror("[ERROR] mlock failed");
+        result = -1;
+    }
+
+    if (!per_size_class_counts) return result;
+
+    if (!lock_pool()) return -1;
+
+    // Carve with the normal allocation path. The blocks stay allocated
+    // until all are carved, or later carves would reuse earlier ones;
+    // meanwhile they are chained through their payloads.
+    size_t carved_list = 0;
+    int pool_full = 0;
+    for (int size_class = 0; size_class < ALLOC_SIZE_CLASSES; size_class++) {
+        size_t class_bytes = my_size_class_bytes(size_class);
+        size_t carved = 0;
+
+        while (carved < per_size_class_counts[size_class]) {
+            int path;
+            void* ptr = malloc_unlocked(class_bytes, ALIGNMENT, 0, &path);
+            if (!ptr) {
+                pool_full = 1;
+                result = -1;
+                break;
+            }
+            *(size_t*)ptr = carved_list;
+            carved_list = offset_of(ptr);
+            carved++;
+        }
+        if (carved < per_size_class_counts[size_class]) {
+            printf("[WARMUP] Carved only %zu of %zu blocks of %zu bytes, pool is full; releasing all carved blocks\n",
+                carved, per_size_class_counts[size_class], class_bytes);
+        } else if (carved > 0) {
+            printf("[WARMUP] Carved %zu blocks of %zu bytes\n", carved, class_bytes);
+        }
+        if (pool_full) break;
+    }
+
+    // Now hand them all back: without coalescing, or through the normal
+    // free path if carving fell short, so a full pool is not left tiled
+    while (carved_list != 0) {
+        void* ptr = (char*)memory_pool + carved_list;
+        block_header_t* header = (block_header_t*) ((char*)ptr - sizeof(block_header_t));
+        carved_list = *(size_t*)ptr;
+        if (pool_full) {
+            size_t freed_size;
+            free_unlocked(ptr, &freed_size);
+        } else {
+            header->magic = FREED_MAGIC;
+            header->is_free = 1;
+        }
+    }
+
+    unlock_pool();
+    return result;
+}
+
+/*
+ * Root object: the entry point a restarted process uses to find its data
+ * again. Only the offset is stored, so it survives remapping.
+ */
+void my_set_root(void* ptr) {
+    if (!initialized) init_allocator();
+    if (!initialized) return;
+
+    if (ptr && !in_pool(ptr)) {
+        printf("[ERROR] Root %p does not belong to the pool\n", ptr);
+        return;
+    }
+    if (!lock_pool()) return;
+    pool->root_offset = offset_of(ptr);
+    unlock_pool();
+}
+
+void* my_get_root(void) {
+    if (!initialized || pool->root_offset == 0) return NULL;
+    return (char*)memory_pool + pool->root_offset;
+}
+
+uint64_t my_pool_generation(void) {
+    return initialized ? pool->generation : 0;
+}
+
+size_t my_to_offset(const void* ptr) {
+    return in_pool(ptr) ? offset_of(ptr) : 0;
+}
+
+void* my_from_offset(size_t offset) {
+    if (!initialized || offset == 0 || offset >= POOL_SIZE) return NULL;
+    return (char*)memory_pool + offset;
+}
+
+void my_allocator_set_verbose(int enabled) {
+    verbose = enabled;
+}
+
+void my_latency_enable(int enabled) {
+    latency_enabled = enabled;
+}
+
+void my_latency_reset(void) {
+    for (int op = 0; op < ALLOC_OPS; op++)
+        for (int path = 0; path < ALLOC_PATHS; path++)
+            for (int size_class = 0; size_class < ALLOC_SIZE_CLASSES; size_class++)
+                for (int bucket = 0; bucket < LATENCY_BUCKETS; bucket++)
+                    __atomic_store_n(&latency_hist[op][path][size_class][bucket], 0, __ATOMIC_RELAXED);
+}
+
+// Bucket counts for one histogram, or summed over all size classes
+static uint64_t latency_bucket_count(int op, int path, int size_class, int bucket) {
+    if (size_class != ALLOC_ALL_SIZE_CLASSES) {
+        return __atomic_load_n(&latency_hist[op][path][size_class][bucket], __ATOMIC_RELAXED);
+    }
+    uint64_t count = 0;
+    for (int i = 0; i < ALLOC_SIZE_CLASSES; i++) {
+        count += __atomic_load_n(&latency_hist[op][path][i][bucket], __ATOMIC_RELAXED);
+    }
+    return count;
+}
+
+static int latency_args_valid(int op, int path, int size_class) {
+    return op >= 0 && op < ALLOC_OPS && path >= 0 && path < ALLOC_PATHS &&
+           (size_class == ALLOC_ALL_SIZE_CLASSES || (size_class >= 0 && size_class < ALLOC_SIZE_CLASSES));
+}
+
+uint64_t my_latency_count(int op, int path, int size_class) {
+    if (!latency_args_valid(op, path, size_class)) return 0;
+
+    uint64_t count = 0;
+    for (int bucket = 0; bucket < LATENCY_BUCKETS; bucket++) {
+        count += latency_bucket_count(op, path, size_class, bucket);
+    }
+    return count;
+}
+
+uint64_t my_latency_percentile(int op, int path, int size_class, double percentile) {
+    if (!latency_args_valid(op, path, size_class)) return 0;
+
+    uint64_t total = my_latency_count(op, path, size_class);
+    if (total == 0) return 0;
+
+    uint64_t rank = (uint64_t)(percentile / 100.0 * (double)total + 0.5);
+    if (rank < 1) rank = 1;
+    if (rank > total) rank = total;
+
+    uint64_t seen = 0;
+    for (int bucket = 0; bucket < LATENCY_BUCKETS; bucket++) {
+        seen += latency_bucket_count(op, path, size_class, bucket);
+        if (seen >= rank) return latency_bucket_limit(bucket);
+    }
+    return latency_bucket_limit(LATENCY_BUCKETS - 1);
+}
+
+void print_latency_histograms(void) {
+    static const char* op_names[ALLOC_OPS] = { "malloc", "free" };
+    static const char* path_names[ALLOC_PATHS] = { "hit", "split", "coalesce", "fail" };
+
+    printf("\n=== Allocator Latency (%s, bucket upper bounds) ===\n", LATENCY_UNIT);
+    printf("%-7s %-9s %7s %10s %8s %8s %8s %8s\n", "op", "path", "class", "count", "p50", "p99", "p99.9", "max");
+    for (int op = 0; op < ALLOC_OPS; op++) {
+        for (int path = 0; path < ALLOC_PATHS; path++) {
+            for (int size_class = 0; size_class < ALLOC_SIZE_CLASSES; size_class++) {
+                uint64_t count = my_latency_count(op, path, size_class);
+                if (count == 0) continue;
+
+                char class_name[16];
+                if (size_class == ALLOC_SIZE_CLASSES - 1) {
+                    snprintf(class_name, sizeof(class_name), ">%zu", my_size_class_bytes(size_class - 1));
+                } else {
+                    snprintf(class_name, sizeof(class_name), "<=%zu", my_size_class_bytes(size_class));
+                }
+                printf("%-7s %-9s %7s %10llu %8llu %8llu %8llu %8llu\n",
+                    op_names[op], path_names[path], class_name,
+                    (unsigned long long)count,
+                    (unsigned long long)my_latency_percentile(op, path, size_class, 50.0),
+                    (unsigned long long)my_latency_percentile(op, path, size_class, 99.0),
+                    (unsigned long long)my_latency_percentile(op, path, size_class, 99.9),
+                    (unsigned long long)my_latency_percentile(op, path, size_class, 100.0));
+            }
+        }
+    }
+    printf("===================\n\n");
+}
+
+void my_allocator_stats(allocator_stats_t* stats) {
+    memset(stats, 0, sizeof(*stats));
+    if (!initialized) return;
+
+    if (!lock_pool()) return;
+    for (block_header_t* current = free_list_head; current != NULL; current = block_at(current->next)) {
+        if (current->is_free) {
+            stats->total_free += current->size;
+            stats->free_blocks++;
+            if (current->size > stats->largest_free) stats->largest_free = current->size;
+        } else {
+            stats->total_used += current->size;
+            stats->used_blocks++;
+        }
+    }
+    unlock_pool();
+}
+
+void print_memory_state() {
+    printf("\n=== Memory State ===\n");
+    if (pool && !lock_pool()) return;
+    block_header_t* current = free_list_head;
+    int block_num = 0;
+    size_t total_free = 0;
+    size_t total_allocated = 0;
+
+    while (current != NULL) {
+        printf("Block %d: size=%zu, %s, addr=%p\n",
+            block_num++,
+            current->size,
+            current->is_free ? "FREE" : "ALLOCATED",
+            (void*)current);
+
+        if (current->is_free) {
+            total_free += current->size;
+        } else {
+            total_allocated += current->size;
+        }
+
+        current = block_at(current->next);
+    }
+
+    if (pool) unlock_pool();
+
+    printf("Total free: %zu bytes\n", total_free);
+    printf("Total used: %zu bytes\n", total_allocated);
+    printf("===================\n\n");
+}
@@ -0,0 +1,100 @@
+#include <cstdio>
+#include <cstdint>
+#include <functional>
+#include <memory_resource>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "allocator.hpp"
+
+using namespace my_allocator;
+
+static int failures = 0;
+
+static void check(bool condition, const char* what) {
+    if (condition) {
+        std::printf("✓ %s\n", what);
+    } else {
+        std::printf("❌ %s\n", what);
+        failures++;
+    }
+}
+
+static bool on_heap(const void* ptr) {
+    return my_to_offset(ptr) != 0;
+}
+
+struct alignas(64) cache_line {
+    char bytes[64];
+};
+
+/*****************************************
+ * C++ adapter tests (dynamic allocator) *
+ *****************************************/
+static void test_stl_allocator() {
+    std::printf("--- STL Allocator: std::vector ---\n");
+    std::vector<int, heap_allocator<int>> numbers;
+    for (int i = 0; i < 100; i++) numbers.push_back(i);
+    check(on_heap(numbers.data()), "vector storage lives in the pool");
+    check(numbers[99] == 99, "vector contents intact after growth");
+
+    std::printf("--- STL Allocator: std::unordered_map ---\n");
+    using map_alloc = heap_allocator<std::pair<const int, int>>;
+    std::unordered_map<int, int, std::hash<int>, std::equal_to<int>, map_alloc> squares;
+    for (int i = 0; i < 20; i++) squares[i] = i * i;
+    check(squares.size() == 20 && squares[7] == 49, "unordered_map works on the heap");
+
+    std::printf("--- STL Allocator: Over-Aligned Type ---\n");
+    std::vector<cache_line, heap_allocator<cache_line>> lines(3);
+    check((uintptr_t)lines.data() % 64 == 0, "alignas(64) elements are 64-byte aligned");
+}
+
+static void test_memory_resource() {
+    std::printf("--- Memory Resource: pmr Containers ---\n");
+    std::pmr::memory_resource* heap = heap_memory_resource();
+    {
+        std::pmr::vector<std::pmr::string> words(heap);
+        words.emplace_back("a string long enough to skip the small buffer");
+        words.emplace_back("and another one of those, on the same heap");
+        check(on_heap(words.data()) && on_heap(words[0].data()), "pmr vector and strings use the heap");
+    }
+    check(heap->is_equal(*heap_memory_resource()), "heap resources compare equal");
+    check(!heap->is_equal(*std::pmr::new_delete_resource()), "heap differs from new/delete");
+
+    std::printf("--- Memory Resource: Aligned Allocation ---\n");
+    void* block = heap->allocate(100, 256);
+    check((uintptr_t)block % 256 == 0, "256-byte alignment honoured");
+    heap->deallocate(block, 100, 256);
+}
+
+static void test_monotonic_resource() {
+    std::printf("--- Monotonic Resource ---\n");
+    heap_monotonic_resource arena(4096);
+    std::pmr::vector<int> a(&arena);
+    std::pmr::vector<int> b(&arena);
+    for (int i = 0; i < 50; i++) {
+        a.push_back(i);
+        b.push_back(-i);
+    }
+    check(on_heap(a.data()) && on_heap(b.data()), "arena chunks come from the heap");
+    check(a[49] == 49 && b[49] == -49, "arena-backed vectors intact");
+}
+
+int main() {
+    std::printf("C++ Adapter Tests\n");
+    init_allocator();
+
+    test_stl_allocator();
+    test_memory_resource();
+    test_monotonic_resource();
+
+    // Every adapter has released its memory, so the pool should be one block again
+    void* whole = my_malloc(1000 * 1000);
+    check(whole != nullptr, "all container memory returned to the pool");
+    my_free(whole);
+
+    cleanup_allocator();
+    std::printf("\n%s (%d failure%s)\n", failures ? "FAILED" : "PASSED", failures, failures == 1 ? "" : "s");
+    return failures ? 1 : 0;
+}
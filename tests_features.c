@@ -0,0 +1,443 @@
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#include "allocator.h"
+
+#define HEAP_FILE "/tmp/allocator_test_heap.bin"
+#define SHM_NAME "/allocator_test_heap"
+#define WORKERS 4
+#define REQUESTS 200
+#define IN_FLIGHT 4
+
+typedef struct mailbox {
+    size_t request;             // Offset of the parent's message
+    size_t replies[WORKERS];    // Offsets of each worker's reply
+} mailbox_t;
+
+typedef struct cache_root {
+    int entries;
+    size_t names[3];            // Pool offsets, valid in any mapping
+} cache_root_t;
+
+static int failures = 0;
+
+static void check(int condition, const char* what) {
+    if (condition) {
+        printf("✓ %s\n", what);
+    } else {
+        printf("❌ %s\n", what);
+        failures++;
+    }
+}
+
+/**************************************************
+ * Feature tests for the dynamic allocator only   *
+ **************************************************/
+static void test_persistent_heap(void) {
+    printf("--- Persistent Heap: First Run ---\n");
+    unlink(HEAP_FILE);
+
+    check(init_allocator_persistent(HEAP_FILE) == ALLOC_PERSIST_CREATED, "new heap file created");
+    cache_root_t* root = my_malloc(sizeof(cache_root_t));
+    const char* names[3] = { "alpha", "beta", "gamma" };
+    root->entries = 3;
+    for (int i = 0; i < 3; i++) {
+        char* name = my_malloc(16);
+        strcpy(name, names[i]);
+        root->names[i] = my_to_offset(name);
+    }
+    my_set_root(root);
+    check(my_get_root() == root, "root object registered");
+    my_set_root(my_from_offset(8));
+    check(my_get_root() == root, "pointer into the pool header rejected as root");
+    my_free(my_from_offset(8));     // Must be refused, not read a header before the mapping
+    cleanup_allocator();
+
+    printf("--- Persistent Heap: Warm Restart ---\n");
+    // A second process, forked before the reopen so it has no allocator state,
+    // tries to open the file once the parent holds it
+    int ready[2];
+    pipe(ready);
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+        char go;
+        close(ready[1]);
+        read(ready[0], &go, 1);
+        int refused = init_allocator_persistent(HEAP_FILE) == ALLOC_PERSIST_ERROR;
+        fflush(stdout);
+        _exit(refused ? 0 : 1);
+    }
+    close(ready[0]);
+
+    check(init_allocator_persistent(HEAP_FILE) == ALLOC_PERSIST_RECOVERED, "heap recovered after clean shutdown");
+    check(my_pool_generation() == 2, "generation bumped on reopen");
+    root = my_get_root();
+    check(root != NULL && root->entries == 3, "root object found again");
+    check(root != NULL && strcmp(my_from_offset(root->names[2]), "gamma") == 0, "root contents survived restart");
+    print_memory_state();
+
+    fflush(stdout);
+    write(ready[1], "g", 1);
+    close(ready[1]);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    check(WIFEXITED(status) && WEXITSTATUS(status) == 0, "second open of a held heap file refused");
+    cleanup_allocator();
+
+    printf("--- Persistent Heap: Crash Detection ---\n");
+    fflush(stdout);
+    pid = fork();
+    if (pid == 0) {
+        init_allocator_persistent(HEAP_FILE);
+        my_malloc(64);
+        _exit(0);   // Die without cleanup_allocator()
+    }
+    waitpid(pid, NULL, 0);
+    check(init_allocator_persistent(HEAP_FILE) == ALLOC_PERSIST_RECOVERED_DIRTY, "unclean shutdown detected");
+    check(my_pool_generation() == 4, "generation counts every open");
+    cleanup_allocator();
+
+    printf("--- Persistent Heap: Creator Died Before Formatting ---\n");
+    struct stat st;
+    stat(HEAP_FILE, &st);
+    truncate(HEAP_FILE, 0);
+    truncate(HEAP_FILE, st.st_size);    // Sized, but all zeroes
+    check(init_allocator_persistent(HEAP_FILE) == ALLOC_PERSIST_CREATED, "unformatted heap file formatted as new");
+    check(my_get_root() == NULL && my_pool_generation() == 1, "reformatted heap starts empty");
+    cleanup_allocator();
+    unlink(HEAP_FILE);
+}
+
+static void test_shared_heap(void) {
+    printf("--- Shared Heap: Zero-Copy Messages Across fork() ---\n");
+    check(init_allocator_shared(NULL) == ALLOC_SHARED_CREATED, "anonymous shared heap created");
+
+    mailbox_t* box = my_malloc(sizeof(mailbox_t));
+    memset(box, 0, sizeof(mailbox_t));
+    char* request = my_malloc(32);
+    strcpy(request, "ping");
+    box->request = my_to_offset(request);
+    my_set_root(box);
+
+    pid_t pids[WORKERS];
+    for (int i = 0; i < WORKERS; i++) {
+        fflush(stdout);
+        pids[i] = fork();
+        if (pids[i] == 0) {
+            mailbox_t* shared_box = my_get_root();
+            const char* message = my_from_offset(shared_box->request);
+
+            // Churn the heap while the other workers do the same
+            for (int j = 0; j < 20; j++) {
+                void* scratch = my_malloc(16 + 8 * j);
+                my_free(scratch);
+            }
+
+            char* reply = my_malloc(32);
+            snprintf(reply, 32, "%s-pong-%d", message, i);
+            shared_box->replies[i] = my_to_offset(reply);
+            _exit(0);
+        }
+    }
+    for (int i = 0; i < WORKERS; i++) {
+        waitpid(pids[i], NULL, 0);
+    }
+
+    int replies_ok = 1;
+    for (int i = 0; i < WORKERS; i++) {
+        char expected[32];
+        snprintf(expected, sizeof(expected), "ping-pong-%d", i);
+        char* reply = my_from_offset(box->replies[i]);
+        if (!reply || strcmp(reply, expected) != 0) replies_ok = 0;
+        my_free(reply);     // Allocated by the child, freed by the parent
+    }
+    check(replies_ok, "every worker's reply read in place");
+
+    my_free(request);
+    my_free(box);
+    void* whole = my_malloc(1000 * 1000);
+    check(whole != NULL, "heap fully coalesced after cross-process frees");
+    my_free(whole);
+    cleanup_allocator();
+
+    printf("--- Shared Heap: Attach By Name ---\n");
+    shm_unlink(SHM_NAME);
+    check(init_allocator_shared(SHM_NAME) == ALLOC_SHARED_CREATED, "named shared heap created");
+    char* note = my_malloc(32);
+    strcpy(note, "hello");
+    my_set_root(note);
+
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+        // Drop the inherited mapping and attach like an unrelated process would
+        cleanup_allocator();
+        int status = init_allocator_shared(SHM_NAME);
+        char* seen = my_get_root();
+        int ok = status == ALLOC_SHARED_ATTACHED && seen && strcmp(seen, "hello") == 0;
+        my_free(seen);
+        _exit(ok ? 0 : 1);
+    }
+    int status = 0;
+    waitpid(pid, &status, 0);
+    check(WIFEXITED(status) && WEXITSTATUS(status) == 0, "second process attached and read the root");
+    check(my_get_root() == NULL, "root freed by the other process");
+    cleanup_allocator();
+    check(my_shared_unlink(SHM_NAME) == 0, "named shared heap unlinked");
+
+    printf("--- Shared Heap: Creator Died Before Formatting ---\n");
+    int stale = shm_open(SHM_NAME, O_RDWR | O_CREAT | O_EXCL, 0600);
+    ftruncate(stale, 1024 * 1024);
+    close(stale);
+    check(init_allocator_shared(SHM_NAME) == ALLOC_SHARED_ERROR, "attach to unformatted heap times out");
+    my_shared_unlink(SHM_NAME);
+
+    printf("--- Shared Heap: Lock Owner Died Mid-Corruption ---\n");
+    init_allocator_shared(NULL);
+    char* victim = my_malloc(40);
+    int stuck[2];
+    pipe(stuck);
+
+    fflush(stdout);
+    pid = fork();
+    if (pid == 0) {
+        // Smash the next block's header, then stall in my_malloc()'s trace
+        // output on a full pipe while holding the pool lock
+        memset(victim + 40, 0x55, 40);
+        dup2(stuck[1], STDOUT_FILENO);
+        setvbuf(stdout, NULL, _IONBF, 0);
+        fcntl(STDOUT_FILENO, F_SETFL, O_NONBLOCK);
+        while (write(STDOUT_FILENO, "x", 1) == 1) {}
+        fcntl(STDOUT_FILENO, F_SETFL, 0);
+        my_allocator_set_verbose(1);
+        my_malloc(16);
+        _exit(0);
+    }
+    // Wait until the child is asleep in write(), then kill it
+    char stat_path[64], state = 'R';
+    snprintf(stat_path, sizeof(stat_path), "/proc/%d/stat", (int)pid);
+    while (state != 'S') {
+        usleep(1000);
+        FILE* stat_file = fopen(stat_path, "r");
+        if (!stat_file) break;
+        if (fscanf(stat_file, "%*d %*s %c", &state) != 1) state = 'R';
+        fclose(stat_file);
+    }
+    kill(pid, SIGKILL);
+    waitpid(pid, NULL, 0);
+    close(stuck[0]);
+    close(stuck[1]);
+
+    check(my_malloc(16) == NULL, "malloc refused after the heap was left corrupted");
+    check(my_malloc(16) == NULL, "pool stays unusable");
+    my_free(victim);
+    cleanup_allocator();
+}
+
+/*
+ * Request-handler shaped workload: every request builds a couple of
+ * temporaries that live until a few requests later, and keeps one cache
+ * entry for good. Leaves the stats after all temporaries are gone.
+ */
+static void run_request_workload(int use_hints, allocator_stats_t* stats) {
+    void* entries[REQUESTS];
+    void* in_flight[IN_FLIGHT][2] = { { NULL } };
+    int temp_flags = use_hints ? ALLOC_SHORT_LIVED : 0;
+    int entry_flags = use_hints ? ALLOC_LONG_LIVED : 0;
+
+    init_allocator();
+    for (int i = 0; i < REQUESTS; i++) {
+        void** slot = in_flight[i % IN_FLIGHT];
+        my_free(slot[0]);
+        my_free(slot[1]);
+
+        slot[0] = my_malloc_hint(256, temp_flags);
+        slot[1] = my_malloc_hint(512 + 8 * (i % 16), temp_flags);
+        entries[i] = my_malloc_hint(64, entry_flags);
+    }
+    for (int i = 0; i < IN_FLIGHT; i++) {
+        my_free(in_flight[i][0]);
+        my_free(in_flight[i][1]);
+    }
+    my_allocator_stats(stats);
+    for (int i = 0; i < REQUESTS; i++) {
+        my_free(entries[i]);
+    }
+    cleanup_allocator();
+}
+
+static void test_lifetime_hints(void) {
+    printf("--- Lifetime Hints: Hot Objects Packed Together ---\n");
+    init_allocator();
+    // Untagged traffic, including the C++ adapters' aligned allocations, arrives first
+    char* untagged = my_malloc(64);
+    char* aligned = my_aligned_alloc(64, 64);
+    char* cold = my_malloc_hint(64, ALLOC_LONG_LIVED);
+    char* hot_a = my_malloc_hint(64, ALLOC_HOT);
+    char* temp = my_malloc_hint(64, ALLOC_SHORT_LIVED);
+    char* hot_b = my_malloc_hint(64, ALLOC_HOT);
+    check(hot_b - hot_a < 128, "consecutive hot objects are adjacent");
+    check(hot_a < cold && cold < temp, "hot, long-lived and short-lived regions are ordered");
+    check(hot_a < untagged && hot_a < aligned, "unhinted allocations stay out of the hot region");
+    my_free(untagged);
+    my_free(aligned);
+    my_free(hot_a);
+    my_free(hot_b);
+    my_free(temp);
+    my_free(cold);
+    allocator_stats_t stats;
+    my_allocator_stats(&stats);
+    check(stats.free_blocks == 1, "regions coalesce back into one block");
+    cleanup_allocator();
+
+    printf("--- Lifetime Hints: Mixed-Lifetime Fragmentation ---\n");
+    allocator_stats_t unhinted, hinted;
+    run_request_workload(0, &unhinted);
+    run_request_workload(1, &hinted);
+    printf("Free space split into %zu blocks unhinted, %zu with hints\n", unhinted.free_blocks, hinted.free_blocks);
+    check(hinted.free_blocks < unhinted.free_blocks, "hints keep free space contiguous");
+}
+
+static void test_warmup(void) {
+    printf("--- Warm-Up: Prefault And Pre-Carve ---\n");
+    init_allocator();
+
+    size_t counts[ALLOC_SIZE_CLASSES] = { 4, 4, 2 };
+    check(my_allocator_warmup(0, counts, 0) == 0, "warm-up succeeded");
+
+    allocator_stats_t before, after;
+    my_allocator_stats(&before);
+    // Carved blocks sit above the untouched hot region, followed by the rest of the pool
+    check(before.free_blocks == 1 + 4 + 4 + 2 + 1, "free blocks pre-carved per size class");
+
+    void* small = my_malloc(50);    // Size class 1 (64 bytes)
+    my_allocator_stats(&after);
+    check(after.free_blocks == before.free_blocks - 1, "allocation took a carved block whole");
+    my_free(small);
+
+    // Everything was prefaulted, so writing the pool costs no page faults
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    long faults_before = usage.ru_minflt;
+    char* big = my_malloc(512 * 1024);
+    memset(big, 0xAB, 512 * 1024);
+    getrusage(RUSAGE_SELF, &usage);
+    long faults = usage.ru_minflt - faults_before;
+    printf("Page faults writing 512KB after warm-up: %ld\n", faults);
+    check(faults < 16, "no first-touch faults after warm-up");
+    my_free(big);
+
+    allocator_stats_t unfilled, released;
+    my_allocator_stats(&unfilled);
+    size_t too_many[ALLOC_SIZE_CLASSES] = { 0, 0, 0, 0, 0, 0, 0, 1000 };
+    check(my_allocator_warmup(0, too_many, 0) == -1, "carving more than fits reports failure");
+    my_allocator_stats(&released);
+    check(released.free_blocks <= unfilled.free_blocks && released.largest_free >= unfilled.largest_free,
+        "partial warm-up merges its carved blocks back");
+    void* after_full = my_malloc(100000);
+    check(after_full != NULL, "large allocation succeeds after a partial warm-up");
+    my_free(after_full);
+
+    int locked = my_allocator_warmup(0, NULL, ALLOC_WARMUP_MLOCK);
+    printf("mlock %s (may be refused by RLIMIT_MEMLOCK)\n", locked == 0 ? "succeeded" : "failed");
+    cleanup_allocator();
+}
+
+static void test_oversized_request(void) {
+    printf("--- Oversized Requests ---\n");
+    init_allocator();
+
+    // Sizes this close to SIZE_MAX wrap when rounded up to the alignment
+    check(my_malloc((size_t)-3) == NULL, "request near SIZE_MAX is refused");
+    check(my_malloc_hint((size_t)-1, ALLOC_SHORT_LIVED) == NULL, "hinted request near SIZE_MAX is refused");
+    check(my_malloc(1 << 24) == NULL, "request larger than the pool is refused");
+
+    void* ptr = my_malloc(64);
+    check(ptr != NULL, "heap still usable afterwards");
+    my_free(ptr);
+    cleanup_allocator();
+}
+
+static void test_latency_histograms(void) {
+    printf("--- Latency Histograms ---\n");
+    init_allocator();
+    my_allocator_set_verbose(0);
+    my_latency_reset();
+    my_latency_enable(1);
+
+    void* blocks[64];
+    for (int round = 0; round < 10; round++) {
+        for (int i = 0; i < 64; i++) blocks[i] = my_malloc(16 + 24 * i);
+        for (int i = 0; i < 64; i += 2) my_free(blocks[i]);         // Isolated holes
+        for (int i = 0; i < 64; i += 2) blocks[i] = my_malloc(16 + 24 * i);  // Refill them whole
+        for (int i = 0; i < 64; i++) my_free(blocks[i]);            // Merging frees
+    }
+    my_malloc(2 * 1024 * 1024);     // Out of memory
+
+    my_latency_enable(0);
+    my_allocator_set_verbose(1);
+
+    check(my_latency_count(ALLOC_OP_MALLOC, ALLOC_PATH_SPLIT, ALLOC_ALL_SIZE_CLASSES) > 0, "split allocations recorded");
+    check(my_latency_count(ALLOC_OP_MALLOC, ALLOC_PATH_HIT, ALLOC_ALL_SIZE_CLASSES) > 0, "fast-hit allocations recorded");
+    check(my_latency_count(ALLOC_OP_MALLOC, ALLOC_PATH_FAIL, ALLOC_SIZE_CLASSES - 1) == 1, "failed allocation recorded in largest class");
+    check(my_latency_count(ALLOC_OP_FREE, ALLOC_PATH_COALESCE, ALLOC_ALL_SIZE_CLASSES) > 0, "coalescing frees recorded");
+    check(my_latency_count(ALLOC_OP_FREE, ALLOC_PATH_HIT, ALLOC_ALL_SIZE_CLASSES) > 0, "non-merging frees recorded");
+
+    uint64_t total = 0;
+    for (int path = 0; path < ALLOC_PATHS; path++) {
+        total += my_latency_count(ALLOC_OP_MALLOC, path, ALLOC_ALL_SIZE_CLASSES);
+    }
+    check(total == 10 * (64 + 32) + 1, "every my_malloc counted once");
+
+    uint64_t p50 = my_latency_percentile(ALLOC_OP_MALLOC, ALLOC_PATH_SPLIT, ALLOC_ALL_SIZE_CLASSES, 50.0);
+    uint64_t p99 = my_latency_percentile(ALLOC_OP_MALLOC, ALLOC_PATH_SPLIT, ALLOC_ALL_SIZE_CLASSES, 99.0);
+    check(p50 > 0 && p50 <= p99, "percentiles are ordered");
+    check(my_latency_count(ALLOC_OPS, ALLOC_PATH_HIT, 0) == 0 &&
+          my_latency_count(ALLOC_OP_MALLOC, -1, 0) == 0 &&
+          my_latency_percentile(ALLOC_OP_MALLOC, ALLOC_PATH_SPLIT, ALLOC_SIZE_CLASSES, 50.0) == 0,
+          "out-of-range queries return 0");
+
+    // A 60-byte request (class 1) taking an 80-byte hole whole must be
+    // freed into class 1 too, not classed by the block's larger capacity
+    void* guard_lo = my_malloc(8);
+    void* hole = my_malloc(72);
+    void* guard_hi = my_malloc(8);
+    my_free(hole);
+    my_latency_reset();
+    my_latency_enable(1);
+    void* slack = my_malloc(60);
+    my_free(slack);
+    my_latency_enable(0);
+    check(slack == hole, "request reused the hole without splitting");
+    check(my_latency_count(ALLOC_OP_MALLOC, ALLOC_PATH_HIT, 1) == 1 &&
+          my_latency_count(ALLOC_OP_FREE, ALLOC_PATH_COALESCE, 1) + my_latency_count(ALLOC_OP_FREE, ALLOC_PATH_HIT, 1) == 1,
+          "malloc and free of one object land in the same size class");
+    my_free(guard_lo);
+    my_free(guard_hi);
+
+    print_latency_histograms();
+    cleanup_allocator();
+}
+
+int main() {
+    printf("Dynamic Allocator Feature Tests\n");
+
+    test_persistent_heap();
+    test_shared_heap();
+    test_lifetime_hints();
+    test_warmup();
+    test_oversized_request();
+    test_latency_histograms();
+
+    printf("\n%s (%d failure%s)\n", failures ? "FAILED" : "PASSED", failures, failures == 1 ? "" : "s");
+    return failures ? 1 : 0;
+}